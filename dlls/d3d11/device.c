@@ -3992,6 +3992,7 @@ static HRESULT STDMETHODCALLTYPE d3d11_device_CreateDeferredContext1(ID3D11Devic
 {
     FIXME("iface %p, flags %#x, context %p stub!\n", iface, flags, context);
 
+    *context = NULL;
     return E_NOTIMPL;
 }
 
@@ -4067,6 +4068,7 @@ static HRESULT STDMETHODCALLTYPE d3d11_device_CreateDeferredContext2(ID3D11Devic
 {
     FIXME("iface %p, flags %#x, context %p stub!\n", iface, flags, context);
 
+    *context = NULL;
     return E_NOTIMPL;
 }
 
@@ -4788,6 +4788,32 @@ static void test_WriteFileGather(void)
     ok( memcmp( rbuf1 + si.dwPageSize / 2, rbuf2, si.dwPageSize - si.dwPageSize / 2 ) == 0,
             "invalid data was read into buffer\n" );
 
+    ResetEvent( evt );
+
+    /* partial last page write */
+    memset( &ovl, 0, sizeof(ovl) );
+    ovl.hEvent = evt;
+    memset( fse, 0, sizeof(fse) );
+    fse[0].Buffer = wbuf;
+    fse[1].Buffer = rbuf2;
+    memset( rbuf2, 0x43, si.dwPageSize );
+    SetLastError( 0xdeadbeef );
+    if (!WriteFileGather( hfile, fse, si.dwPageSize + si.dwPageSize / 2, NULL, &ovl ))
+        ok( GetLastError() == ERROR_IO_PENDING, "WriteFileGather failed err %u\n", GetLastError() );
+
+    ret = GetQueuedCompletionStatus( hiocp2, &size, &key, &povl, 1000 );
+    ok( ret, "GetQueuedCompletionStatus failed err %u\n", GetLastError() );
+    ok( povl == &ovl, "wrong ovl %p\n", povl );
+
+    tx = 0;
+    br = GetOverlappedResult( hfile, &ovl, &tx, TRUE );
+    ok( br == TRUE, "GetOverlappedResult failed: %u\n", GetLastError() );
+    ok( tx == si.dwPageSize + si.dwPageSize / 2, "got unexpected bytes transferred: %u\n", tx );
+    size = GetFileSize( hfile, NULL );
+    ok( size == si.dwPageSize + si.dwPageSize / 2, "got unexpected file size: %u\n", size );
+
+    ResetEvent( evt );
+
     if (pSetFileCompletionNotificationModes)
     {
         br = pSetFileCompletionNotificationModes(hfile, FILE_SKIP_COMPLETION_PORT_ON_SUCCESS);
@@ -839,9 +839,12 @@ static void test_obsolete_flags(void)
 
 static void test_HeapQueryInformation(void)
 {
+    void *ptrs[500];
+    HANDLE heap;
     ULONG info;
     SIZE_T size;
     BOOL ret;
+    UINT i;
 
     pHeapQueryInformation = (void *)GetProcAddress(GetModuleHandleA("kernel32.dll"), "HeapQueryInformation");
     if (!pHeapQueryInformation)
@@ -887,6 +890,45 @@ static void test_HeapQueryInformation(void)
                                 &info, sizeof(info) + 1, NULL);
     ok(ret, "HeapQueryInformation error %u\n", GetLastError());
     ok(info == 0 || info == 1 || info == 2, "expected 0, 1 or 2, got %u\n", info);
+
+    heap = HeapCreate( 0, 0, 0 );
+    ok( heap != NULL, "HeapCreate failed %u\n", GetLastError() );
+
+    info = 2;
+    ret = HeapSetInformation( heap, HeapCompatibilityInformation, &info, sizeof(info) );
+    ok( ret, "HeapSetInformation error %u\n", GetLastError() );
+    info = 0xdeadbeef;
+    ret = pHeapQueryInformation( heap, HeapCompatibilityInformation, &info, sizeof(info), NULL );
+    ok( ret, "HeapQueryInformation error %u\n", GetLastError() );
+    ok( info == 2, "expected 2, got %u\n", info );
+
+    for (i = 0; i < ARRAY_SIZE(ptrs); i++)
+    {
+        ptrs[i] = HeapAlloc( heap, HEAP_ZERO_MEMORY, 1 + i % 200 );
+        ok( ptrs[i] != NULL, "HeapAlloc failed\n" );
+    }
+    for (i = 0; i < ARRAY_SIZE(ptrs); i += 2)
+    {
+        memset( ptrs[i], 0xcc, 1 + i % 200 );
+        ret = HeapFree( heap, 0, ptrs[i] );
+        ok( ret, "HeapFree error %u\n", GetLastError() );
+    }
+    ok( HeapValidate( heap, 0, NULL ), "HeapValidate failed\n" );
+    for (i = 0; i < ARRAY_SIZE(ptrs); i += 2)
+    {
+        ptrs[i] = HeapAlloc( heap, HEAP_ZERO_MEMORY, 1 + i % 200 );
+        ok( ptrs[i] != NULL, "HeapAlloc failed\n" );
+        ok( HeapSize( heap, 0, ptrs[i] ) == 1 + i % 200, "wrong size %lu\n", HeapSize( heap, 0, ptrs[i] ) );
+        for (size = 0; size < 1 + i % 200; size++) if (((BYTE *)ptrs[i])[size]) break;
+        ok( size == 1 + i % 200, "%u: memory not zeroed at %lu\n", i, size );
+    }
+    for (i = 0; i < ARRAY_SIZE(ptrs); i++)
+    {
+        ret = HeapFree( heap, 0, ptrs[i] );
+        ok( ret, "HeapFree error %u\n", GetLastError() );
+    }
+    ok( HeapValidate( heap, 0, NULL ), "HeapValidate failed\n" );
+    HeapDestroy( heap );
 }
 
 static void test_heap_checks( DWORD flags )
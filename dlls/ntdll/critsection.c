@@ -50,6 +50,12 @@ static BOOL crit_section_has_debuginfo(const RTL_CRITICAL_SECTION *crit)
     return crit->DebugInfo != NULL && crit->DebugInfo != no_debug_info_marker;
 }
 
+/* debug info is cleared by MakeCriticalSectionGlobal, a global section needs a semaphore */
+static BOOL crit_section_is_global(const RTL_CRITICAL_SECTION *crit)
+{
+    return crit->DebugInfo == NULL;
+}
+
 /***********************************************************************
  *           get_semaphore
  */
@@ -75,8 +81,7 @@ static inline NTSTATUS wait_semaphore( RTL_CRITICAL_SECTION *crit, int timeout )
 {
     NTSTATUS ret;
 
-    /* debug info is cleared by MakeCriticalSectionGlobal */
-    if (!crit_section_has_debuginfo( crit ) ||
+    if (crit_section_is_global( crit ) ||
         ((ret = unix_funcs->fast_RtlpWaitForCriticalSection( crit, timeout )) == STATUS_NOT_IMPLEMENTED))
     {
         HANDLE sem = get_semaphore( crit );
@@ -245,10 +250,12 @@ NTSTATUS WINAPI RtlDeleteCriticalSection( RTL_CRITICAL_SECTION *crit )
     crit->LockCount      = -1;
     crit->RecursionCount = 0;
     crit->OwningThread   = 0;
-    if (crit_section_has_debuginfo( crit ))
+    if (crit_section_is_global( crit ))
+        NtClose( crit->LockSemaphore );
+    else
     {
         /* only free the ones we made in here */
-        if (!crit->DebugInfo->Spare[0])
+        if (crit_section_has_debuginfo( crit ) && !crit->DebugInfo->Spare[0])
         {
             RtlFreeHeap( GetProcessHeap(), 0, crit->DebugInfo );
             crit->DebugInfo = NULL;
@@ -256,7 +263,6 @@ NTSTATUS WINAPI RtlDeleteCriticalSection( RTL_CRITICAL_SECTION *crit )
         if (unix_funcs->fast_RtlDeleteCriticalSection( crit ) == STATUS_NOT_IMPLEMENTED)
             NtClose( crit->LockSemaphore );
     }
-    else NtClose( crit->LockSemaphore );
     crit->LockSemaphore = 0;
     return STATUS_SUCCESS;
 }
@@ -367,8 +373,7 @@ NTSTATUS WINAPI RtlpUnWaitCriticalSection( RTL_CRITICAL_SECTION *crit )
 {
     NTSTATUS ret;
 
-    /* debug info is cleared by MakeCriticalSectionGlobal */
-    if (!crit_section_has_debuginfo( crit ) ||
+    if (crit_section_is_global( crit ) ||
         ((ret = unix_funcs->fast_RtlpUnWaitCriticalSection( crit )) == STATUS_NOT_IMPLEMENTED))
     {
         HANDLE sem = get_semaphore( crit );
@@ -556,12 +556,37 @@ static RUNTIME_FUNCTION *find_function_info( ULONG_PTR pc, ULONG_PTR base,
 
 /**********************************************************************
  *           lookup_function_info
+ *
+ * On x86_64 the unwind history table is searched first if it is in search
+ * mode, in which case module is set to NULL. Otherwise the function found
+ * is recorded in the table.
  */
-RUNTIME_FUNCTION *lookup_function_info( ULONG_PTR pc, ULONG_PTR *base, LDR_DATA_TABLE_ENTRY **module )
+RUNTIME_FUNCTION *lookup_function_info( ULONG_PTR pc, ULONG_PTR *base, LDR_DATA_TABLE_ENTRY **module,
+                                        UNWIND_HISTORY_TABLE *table )
 {
     RUNTIME_FUNCTION *func = NULL;
     struct dynamic_unwind_entry *entry;
     ULONG size;
+#ifdef __x86_64__
+    ULONG i;
+
+    if (table && table->Search != UNWIND_HISTORY_TABLE_NONE &&
+        pc >= table->LowAddress && pc < table->HighAddress)
+    {
+        for (i = 0; i < table->Count; i++)
+        {
+            func = table->Entry[i].FunctionEntry;
+            if (pc >= table->Entry[i].ImageBase + func->BeginAddress &&
+                pc < table->Entry[i].ImageBase + func->EndAddress)
+            {
+                *base = table->Entry[i].ImageBase;
+                *module = NULL;
+                return func;
+            }
+        }
+        func = NULL;
+    }
+#endif
 
     /* PE module or wine module */
     if (!LdrFindEntryForAddress( (void *)pc, module ))
@@ -595,6 +620,25 @@ RUNTIME_FUNCTION *lookup_function_info( ULONG_PTR pc, ULONG_PTR *base, LDR_DATA_
         RtlLeaveCriticalSection( &dynamic_unwind_section );
     }
 
+#ifdef __x86_64__
+    /* record the function while the history table is being filled */
+    if (func && table && table->Search == UNWIND_HISTORY_TABLE_NONE && table->Count < UNWIND_HISTORY_TABLE_SIZE)
+    {
+        if (!table->Count)
+        {
+            table->LowAddress = *base + func->BeginAddress;
+            table->HighAddress = *base + func->EndAddress;
+        }
+        else
+        {
+            table->LowAddress = min( table->LowAddress, *base + func->BeginAddress );
+            table->HighAddress = max( table->HighAddress, *base + func->EndAddress );
+        }
+        table->Entry[table->Count].ImageBase = *base;
+        table->Entry[table->Count].FunctionEntry = func;
+        table->Count++;
+    }
+#endif
     return func;
 }
 
@@ -607,9 +651,7 @@ PRUNTIME_FUNCTION WINAPI RtlLookupFunctionEntry( ULONG_PTR pc, ULONG_PTR *base,
     LDR_DATA_TABLE_ENTRY *module;
     RUNTIME_FUNCTION *func;
 
-    /* FIXME: should use the history table to make things faster */
-
-    if (!(func = lookup_function_info( pc, base, &module )))
+    if (!(func = lookup_function_info( pc, base, &module, table )))
     {
         *base = 0;
         WARN( "no exception table found for %lx\n", pc );
@@ -76,6 +76,7 @@ typedef struct
 /* Value for arena 'magic' field */
 #define ARENA_INUSE_MAGIC      0x455355
 #define ARENA_PENDING_MAGIC    0xbedead
+#define ARENA_LFH_MAGIC        0x484653
 #define ARENA_FREE_MAGIC       0x45455246
 #define ARENA_LARGE_MAGIC      0x6752614c
 
@@ -163,6 +164,7 @@ typedef struct tagHEAP
     ARENA_INUSE    **pending_free;  /* Ring buffer for pending free requests */
     RTL_CRITICAL_SECTION critSection; /* Critical section for serialization */
     FREE_LIST_ENTRY *freeList;      /* Free lists */
+    SLIST_HEADER    *lfh_lists;     /* Low fragmentation heap lists of cached small blocks */
 } HEAP;
 
 #define HEAP_MAGIC       ((DWORD)('H' | ('E'<<8) | ('A'<<16) | ('P'<<24)))
@@ -170,6 +172,7 @@ typedef struct tagHEAP
 #define HEAP_DEF_SIZE        0x110000   /* Default heap size = 1Mb + 64Kb */
 #define COMMIT_MASK          0xffff  /* bitmask for commit/decommit granularity */
 #define MAX_FREE_PENDING     1024    /* max number of free requests to delay */
+#define MAX_LFH_DEPTH        64      /* max number of cached blocks per low fragmentation heap list */
 
 /* some undocumented flags (names are made up) */
 #define HEAP_PAGE_ALLOCS      0x01000000
@@ -295,7 +298,8 @@ static void subheap_notify_free_all(SUBHEAP const *subheap)
         {
             ARENA_INUSE const *pArena = (ARENA_INUSE const *)ptr;
             if (pArena->magic == ARENA_INUSE_MAGIC) notify_free(pArena + 1);
-            else if (pArena->magic != ARENA_PENDING_MAGIC) ERR("bad inuse_magic @%p\n", pArena);
+            else if (pArena->magic != ARENA_PENDING_MAGIC && pArena->magic != ARENA_LFH_MAGIC)
+                ERR("bad inuse_magic @%p\n", pArena);
             ptr += sizeof(*pArena) + (pArena->size & ARENA_SIZE_MASK);
         }
     }
@@ -386,7 +390,8 @@ static void HEAP_Dump( HEAP *heap )
             {
                 ARENA_INUSE *pArena = (ARENA_INUSE *)ptr;
                 TRACE( "%p %08x %s %08x\n",
-                         pArena, pArena->magic, pArena->magic == ARENA_INUSE_MAGIC ? "used" : "pend",
+                         pArena, pArena->magic, pArena->magic == ARENA_INUSE_MAGIC ? "used" :
+                         pArena->magic == ARENA_LFH_MAGIC ? "lfh " : "pend",
                          pArena->size & ARENA_SIZE_MASK );
                 ptr += sizeof(*pArena) + (pArena->size & ARENA_SIZE_MASK);
                 arenaSize += sizeof(ARENA_INUSE);
@@ -667,10 +672,12 @@ static void HEAP_MakeInUseBlockFree( SUBHEAP *subheap, ARENA_INUSE *pArena )
     if ((char *)pFree + size < (char *)subheap->base + subheap->size)
         return;  /* Not the last block, so nothing more to do */
 
-    /* Free the whole sub-heap if it's empty and not the original one */
+    /* Free the whole sub-heap if it's empty and not the original one. This
+     * is not done with the low fragmentation heap, since lfh_free_block()
+     * walks the sub-heap list without holding the heap lock. */
 
     if (((char *)pFree == (char *)subheap->base + subheap->headerSize) &&
-        (subheap != &subheap->heap->subheap))
+        (subheap != &subheap->heap->subheap) && !subheap->heap->lfh_lists)
     {
         void *addr = subheap->base;
 
@@ -715,6 +722,93 @@ static void HEAP_ShrinkBlock(SUBHEAP *subheap, ARENA_INUSE *pArena, SIZE_T size)
 }
 
 
+/***********************************************************************
+ *           lfh_alloc_block
+ *
+ * Allocate a small block from the low fragmentation heap lists, without
+ * taking the heap lock.
+ */
+static ARENA_INUSE *lfh_alloc_block( HEAP *heap, SIZE_T size )
+{
+    ARENA_INUSE *arena;
+    SLIST_ENTRY *entry;
+
+    if (!(entry = RtlInterlockedPopEntrySList( &heap->lfh_lists[get_freelist_index( size + sizeof(ARENA_INUSE) )] )))
+        return NULL;
+    arena = (ARENA_INUSE *)entry - 1;
+    arena->magic = ARENA_INUSE_MAGIC;
+    return arena;
+}
+
+
+/***********************************************************************
+ *           lfh_free_block
+ *
+ * Put a small block back into the low fragmentation heap lists, without
+ * taking the heap lock. Returns FALSE if the block has to be freed normally.
+ */
+static BOOL lfh_free_block( HEAP *heap, ARENA_INUSE *arena )
+{
+    const SUBHEAP *subheap;
+    struct list *ptr;
+    SLIST_HEADER *list;
+    SIZE_T size;
+
+    if ((ULONG_PTR)arena % ALIGNMENT != ARENA_OFFSET) return FALSE;
+
+    /* The block must be inside one of our sub-heaps. Sub-heaps are never removed
+     * once the low fragmentation heap is enabled, and add_subheap() publishes
+     * them with a single atomic store, so the list can be walked without the
+     * heap lock. Only the immutable base and size fields are used. */
+    for (ptr = InterlockedCompareExchangePointer( (void **)&heap->subheap_list.next, NULL, NULL );
+         ptr != &heap->subheap_list;
+         ptr = InterlockedCompareExchangePointer( (void **)&ptr->next, NULL, NULL ))
+    {
+        subheap = LIST_ENTRY( ptr, SUBHEAP, entry );
+        if ((const char *)arena >= (const char *)subheap->base + subheap->headerSize &&
+            (const char *)(arena + 1) < (const char *)subheap->base + subheap->size)
+            break;
+    }
+    if (ptr == &heap->subheap_list) return FALSE;
+
+    if (arena->magic != ARENA_INUSE_MAGIC || (arena->size & ARENA_FLAG_FREE)) return FALSE;
+    size = (arena->size & ARENA_SIZE_MASK) + sizeof(ARENA_INUSE);
+    if (size > HEAP_MAX_SMALL_FREE_LIST) return FALSE;
+    if ((const char *)arena + size > (const char *)subheap->base + subheap->size) return FALSE;
+
+    list = &heap->lfh_lists[get_freelist_index( size )];
+    if (RtlQueryDepthSList( list ) >= MAX_LFH_DEPTH) return FALSE;
+    arena->magic = ARENA_LFH_MAGIC;
+    RtlInterlockedPushEntrySList( list, (SLIST_ENTRY *)(arena + 1) );
+    return TRUE;
+}
+
+
+/***********************************************************************
+ *           lfh_flush_blocks
+ *
+ * Return all the cached low fragmentation heap blocks to the free lists.
+ * The heap must be locked.
+ */
+static void lfh_flush_blocks( HEAP *heap )
+{
+    SLIST_ENTRY *entry, *next;
+    ARENA_INUSE *arena;
+    unsigned int i;
+
+    for (i = 0; i < HEAP_NB_SMALL_FREE_LISTS; i++)
+    {
+        for (entry = RtlInterlockedFlushSList( &heap->lfh_lists[i] ); entry; entry = next)
+        {
+            next = entry->Next;
+            arena = (ARENA_INUSE *)entry - 1;
+            arena->magic = ARENA_INUSE_MAGIC;
+            HEAP_MakeInUseBlockFree( HEAP_FindSubHeap( heap, arena ), arena );
+        }
+    }
+}
+
+
 /***********************************************************************
  *           allocate_large_block
  */
@@ -869,6 +963,25 @@ static BOOL validate_large_arena( HEAP *heap, const ARENA_LARGE *arena, BOOL qui
 }
 
 
+/***********************************************************************
+ *           add_subheap
+ *
+ * Insert a secondary sub-heap in the heap list. lfh_free_block() walks the
+ * list without the heap lock, so the entry is fully initialized first and
+ * then published with a single atomic store.
+ * The heap must be locked.
+ */
+static void add_subheap( HEAP *heap, SUBHEAP *subheap )
+{
+    struct list *head = &heap->subheap_list;
+
+    subheap->entry.next = head->next;
+    subheap->entry.prev = head;
+    head->next->prev = &subheap->entry;
+    InterlockedExchangePointer( (void **)&head->next, &subheap->entry );
+}
+
+
 /***********************************************************************
  *           HEAP_CreateSubHeap
  */
@@ -914,7 +1027,7 @@ static SUBHEAP *HEAP_CreateSubHeap( HEAP *heap, LPVOID address, DWORD flags,
         subheap->commitSize = commitSize;
         subheap->magic      = SUBHEAP_MAGIC;
         subheap->headerSize = ROUND_SIZE( sizeof(SUBHEAP) );
-        list_add_head( &heap->subheap_list, &subheap->entry );
+        add_subheap( heap, subheap );
     }
     else
     {
@@ -924,6 +1037,7 @@ static SUBHEAP *HEAP_CreateSubHeap( HEAP *heap, LPVOID address, DWORD flags,
         heap->flags         = flags;
         heap->magic         = HEAP_MAGIC;
         heap->grow_size     = max( HEAP_DEF_SIZE, totalSize );
+        heap->lfh_lists     = NULL;
         list_init( &heap->subheap_list );
         list_init( &heap->large_list );
 
@@ -1213,7 +1327,8 @@ static BOOL HEAP_ValidateInUseArena( const SUBHEAP *subheap, const ARENA_INUSE *
     }
 
     /* Check magic number */
-    if (pArena->magic != ARENA_INUSE_MAGIC && pArena->magic != ARENA_PENDING_MAGIC)
+    if (pArena->magic != ARENA_INUSE_MAGIC && pArena->magic != ARENA_PENDING_MAGIC &&
+        pArena->magic != ARENA_LFH_MAGIC)
     {
         if (quiet == NOISY) {
             ERR("Heap %p: invalid in-use arena magic %08x for %p\n", subheap->heap, pArena->magic, pArena );
@@ -1419,7 +1534,7 @@ static BOOL validate_block_pointer( HEAP *heap, SUBHEAP **ret_subheap, const ARE
         ret = HEAP_ValidateInUseArena( subheap, arena, QUIET );
     else if ((ULONG_PTR)arena % ALIGNMENT != ARENA_OFFSET)
         WARN( "Heap %p: unaligned arena pointer %p\n", subheap->heap, arena );
-    else if (arena->magic == ARENA_PENDING_MAGIC)
+    else if (arena->magic == ARENA_PENDING_MAGIC || arena->magic == ARENA_LFH_MAGIC)
         WARN( "Heap %p: block %p used after free\n", subheap->heap, arena + 1 );
     else if (arena->magic != ARENA_INUSE_MAGIC)
         WARN( "Heap %p: invalid in-use arena magic %08x for %p\n", subheap->heap, arena->magic, arena );
@@ -1624,6 +1739,7 @@ HANDLE WINAPI RtlDestroyHeap( HANDLE heap )
     }
     subheap_notify_free_all(&heapPtr->subheap);
     RtlFreeHeap( GetProcessHeap(), 0, heapPtr->pending_free );
+    RtlFreeHeap( GetProcessHeap(), 0, heapPtr->lfh_lists );
     size = 0;
     addr = heapPtr->subheap.base;
     NtFreeVirtualMemory( NtCurrentProcess(), &addr, &size, MEM_RELEASE );
@@ -1669,6 +1785,16 @@ void * WINAPI DECLSPEC_HOTPATCH RtlAllocateHeap( HANDLE heap, ULONG flags, SIZE_
     }
     if (rounded_size < HEAP_MIN_DATA_SIZE) rounded_size = HEAP_MIN_DATA_SIZE;
 
+    if (heapPtr->lfh_lists && rounded_size + sizeof(ARENA_INUSE) <= HEAP_MAX_SMALL_FREE_LIST &&
+        (pInUse = lfh_alloc_block( heapPtr, rounded_size )))
+    {
+        pInUse->unused_bytes = (pInUse->size & ARENA_SIZE_MASK) - size;
+        notify_alloc( pInUse + 1, size, flags & HEAP_ZERO_MEMORY );
+        initialize_block( pInUse + 1, size, pInUse->unused_bytes, flags );
+        TRACE("(%p,%08x,%08lx): returning %p\n", heap, flags, size, pInUse + 1 );
+        return pInUse + 1;
+    }
+
     if (!(flags & HEAP_NO_SERIALIZE)) RtlEnterCriticalSection( &heapPtr->critSection );
 
     if (rounded_size >= HEAP_MIN_LARGE_BLOCK_SIZE && (flags & HEAP_GROWABLE))
@@ -1752,13 +1878,21 @@ BOOLEAN WINAPI DECLSPEC_HOTPATCH RtlFreeHeap( HANDLE heap, ULONG flags, void *pt
 
     flags &= HEAP_NO_SERIALIZE;
     flags |= heapPtr->flags;
+    pInUse  = (ARENA_INUSE *)ptr - 1;
+
+    if (heapPtr->lfh_lists && lfh_free_block( heapPtr, pInUse ))
+    {
+        notify_free( ptr );
+        TRACE("(%p,%08x,%p): returning TRUE\n", heap, flags, ptr );
+        return TRUE;
+    }
+
     if (!(flags & HEAP_NO_SERIALIZE)) RtlEnterCriticalSection( &heapPtr->critSection );
 
     /* Inform valgrind we are trying to free memory, so it can throw up an error message */
     notify_free( ptr );
 
     /* Some sanity checks */
-    pInUse  = (ARENA_INUSE *)ptr - 1;
     if (!validate_block_pointer( heapPtr, &subheap, pInUse )) goto error;
 
     if (!subheap)
@@ -1939,12 +2073,22 @@ error:
  *  The number of bytes compacted.
  *
  * NOTES
- *  This function is a harmless stub.
+ *  This function only returns the cached low fragmentation heap blocks
+ *  to the heap free lists.
  */
 ULONG WINAPI RtlCompactHeap( HANDLE heap, ULONG flags )
 {
     static BOOL reported;
-    if (!reported++) FIXME( "(%p, 0x%x) stub\n", heap, flags );
+    HEAP *heapPtr = HEAP_GetPtr( heap );
+
+    if (!reported++) FIXME( "(%p, 0x%x) semi-stub\n", heap, flags );
+    if (!heapPtr || !heapPtr->lfh_lists) return 0;
+
+    flags &= HEAP_NO_SERIALIZE;
+    flags |= heapPtr->flags;
+    if (!(flags & HEAP_NO_SERIALIZE)) RtlEnterCriticalSection( &heapPtr->critSection );
+    lfh_flush_blocks( heapPtr );
+    if (!(flags & HEAP_NO_SERIALIZE)) RtlLeaveCriticalSection( &heapPtr->critSection );
     return 0;
 }
 
@@ -2119,7 +2263,8 @@ NTSTATUS WINAPI RtlWalkHeap( HANDLE heap, PVOID entry_ptr )
         }
 
         if (((ARENA_INUSE *)ptr - 1)->magic == ARENA_INUSE_MAGIC ||
-            ((ARENA_INUSE *)ptr - 1)->magic == ARENA_PENDING_MAGIC)
+            ((ARENA_INUSE *)ptr - 1)->magic == ARENA_PENDING_MAGIC ||
+            ((ARENA_INUSE *)ptr - 1)->magic == ARENA_LFH_MAGIC)
         {
             ARENA_INUSE *pArena = (ARENA_INUSE *)ptr - 1;
             ptr += pArena->size & ARENA_SIZE_MASK;
@@ -2232,6 +2377,8 @@ ULONG WINAPI RtlGetProcessHeaps( ULONG count, HANDLE *heaps )
 NTSTATUS WINAPI RtlQueryHeapInformation( HANDLE heap, HEAP_INFORMATION_CLASS info_class,
                                          PVOID info, SIZE_T size_in, PSIZE_T size_out)
 {
+    HEAP *heapPtr;
+
     switch (info_class)
     {
     case HeapCompatibilityInformation:
@@ -2240,7 +2387,8 @@ NTSTATUS WINAPI RtlQueryHeapInformation( HANDLE heap, HEAP_INFORMATION_CLASS inf
         if (size_in < sizeof(ULONG))
             return STATUS_BUFFER_TOO_SMALL;
 
-        *(ULONG *)info = 0; /* standard heap */
+        if (!(heapPtr = HEAP_GetPtr( heap ))) return STATUS_INVALID_PARAMETER;
+        *(ULONG *)info = heapPtr->lfh_lists ? 2 /* low fragmentation heap */ : 0 /* standard heap */;
         return STATUS_SUCCESS;
 
     default:
@@ -2254,6 +2402,46 @@ NTSTATUS WINAPI RtlQueryHeapInformation( HANDLE heap, HEAP_INFORMATION_CLASS inf
  */
 NTSTATUS WINAPI RtlSetHeapInformation( HANDLE heap, HEAP_INFORMATION_CLASS info_class, PVOID info, SIZE_T size)
 {
-    FIXME("%p %d %p %ld stub\n", heap, info_class, info, size);
-    return STATUS_SUCCESS;
+    HEAP *heapPtr;
+    SLIST_HEADER *lists;
+    unsigned int i;
+
+    switch (info_class)
+    {
+    case HeapCompatibilityInformation:
+        if (size < sizeof(ULONG)) return STATUS_BUFFER_TOO_SMALL;
+        if (!(heapPtr = HEAP_GetPtr( heap ))) return STATUS_INVALID_PARAMETER;
+
+        if (*(ULONG *)info != 2)
+        {
+            /* the low fragmentation heap can't be disabled once enabled */
+            if (heapPtr->lfh_lists || *(ULONG *)info) return STATUS_UNSUCCESSFUL;
+            return STATUS_SUCCESS;
+        }
+
+        /* not supported for serialized, fixed size or debug heaps */
+        if ((heapPtr->flags & (HEAP_NO_SERIALIZE | HEAP_TAIL_CHECKING_ENABLED | HEAP_FREE_CHECKING_ENABLED |
+                               HEAP_VALIDATE | HEAP_VALIDATE_ALL | HEAP_VALIDATE_PARAMS)) ||
+            !(heapPtr->flags & HEAP_GROWABLE) || heapPtr->pending_free || RUNNING_ON_VALGRIND)
+            return STATUS_UNSUCCESSFUL;
+
+        if (heapPtr->lfh_lists) return STATUS_SUCCESS;
+        if (!(lists = RtlAllocateHeap( GetProcessHeap(), 0, HEAP_NB_SMALL_FREE_LISTS * sizeof(*lists) )))
+            return STATUS_NO_MEMORY;
+        for (i = 0; i < HEAP_NB_SMALL_FREE_LISTS; i++) RtlInitializeSListHead( &lists[i] );
+
+        RtlEnterCriticalSection( &heapPtr->critSection );
+        if (!heapPtr->lfh_lists)
+        {
+            heapPtr->lfh_lists = lists;
+            lists = NULL;
+        }
+        RtlLeaveCriticalSection( &heapPtr->critSection );
+        RtlFreeHeap( GetProcessHeap(), 0, lists );
+        return STATUS_SUCCESS;
+
+    default:
+        FIXME("%p %d %p %ld stub\n", heap, info_class, info, size);
+        return STATUS_SUCCESS;
+    }
 }
@@ -90,6 +90,16 @@ struct dll_dir_entry
 
 static struct list dll_dir_list = LIST_INIT( dll_dir_list );  /* extra dirs from LdrAddDllDirectory */
 
+struct missing_dir
+{
+    struct list   entry;
+    LARGE_INTEGER parent_time;  /* last write time of the parent directory */
+    ULONG         len;
+    WCHAR         dir[1];       /* dos path including the trailing backslash */
+};
+
+static struct list missing_dirs = LIST_INIT( missing_dirs );  /* nonexistent dirs of the search path */
+
 struct ldr_notification
 {
     struct list                    entry;
@@ -118,6 +128,7 @@ struct file_id
 typedef struct _wine_modref
 {
     LDR_DATA_TABLE_ENTRY  ldr;
+    LIST_ENTRY            hash_links;
     struct file_id        id;
     void                 *unix_entry;
     int                   alloc_deps;
@@ -160,6 +171,9 @@ static PEB_LDR_DATA ldr = { sizeof(ldr), TRUE };
 static RTL_BITMAP tls_bitmap;
 static RTL_BITMAP tls_expansion_bitmap;
 
+#define HASH_MAP_SIZE 32
+static LIST_ENTRY hash_table[HASH_MAP_SIZE];  /* modules hashed by base name */
+
 static WINE_MODREF *cached_modref;
 static WINE_MODREF *current_modref;
 static WINE_MODREF *last_failed_modref;
@@ -477,6 +491,21 @@ static WINE_MODREF *get_modref( HMODULE hmod )
 }
 
 
+/**********************************************************************
+ *	    hash_basename
+ *
+ * Get the hash table bucket for a module base name.
+ */
+static LIST_ENTRY *hash_basename( const UNICODE_STRING *name )
+{
+    ULONG i, hash = 0;
+
+    for (i = 0; i < name->Length / sizeof(WCHAR); i++)
+        hash = hash * 65599 + RtlUpcaseUnicodeChar( name->Buffer[i] );
+    return &hash_table[hash % HASH_MAP_SIZE];
+}
+
+
 /**********************************************************************
  *	    find_basename_module
  *
@@ -493,13 +522,13 @@ static WINE_MODREF *find_basename_module( LPCWSTR name )
     if (cached_modref && RtlEqualUnicodeString( &name_str, &cached_modref->ldr.BaseDllName, TRUE ))
         return cached_modref;
 
-    mark = &NtCurrentTeb()->Peb->LdrData->InLoadOrderModuleList;
+    mark = hash_basename( &name_str );
     for (entry = mark->Flink; entry != mark; entry = entry->Flink)
     {
-        LDR_DATA_TABLE_ENTRY *mod = CONTAINING_RECORD(entry, LDR_DATA_TABLE_ENTRY, InLoadOrderLinks);
-        if (RtlEqualUnicodeString( &name_str, &mod->BaseDllName, TRUE ))
+        WINE_MODREF *wm = CONTAINING_RECORD( entry, WINE_MODREF, hash_links );
+        if (RtlEqualUnicodeString( &name_str, &wm->ldr.BaseDllName, TRUE ))
         {
-            cached_modref = CONTAINING_RECORD(mod, WINE_MODREF, ldr);
+            cached_modref = wm;
             return cached_modref;
         }
     }
@@ -516,7 +545,8 @@ static WINE_MODREF *find_basename_module( LPCWSTR name )
 static WINE_MODREF *find_fullname_module( const UNICODE_STRING *nt_name )
 {
     PLIST_ENTRY mark, entry;
-    UNICODE_STRING name = *nt_name;
+    UNICODE_STRING name = *nt_name, base_name;
+    USHORT i;
 
     if (name.Length <= 4 * sizeof(WCHAR)) return NULL;
     name.Length -= 4 * sizeof(WCHAR);  /* for \??\ prefix */
@@ -525,13 +555,17 @@ static WINE_MODREF *find_fullname_module( const UNICODE_STRING *nt_name )
     if (cached_modref && RtlEqualUnicodeString( &name, &cached_modref->ldr.FullDllName, TRUE ))
         return cached_modref;
 
-    mark = &NtCurrentTeb()->Peb->LdrData->InLoadOrderModuleList;
+    for (i = name.Length / sizeof(WCHAR); i > 0; i--) if (name.Buffer[i - 1] == '\\') break;
+    base_name.Buffer = name.Buffer + i;
+    base_name.Length = base_name.MaximumLength = name.Length - i * sizeof(WCHAR);
+
+    mark = hash_basename( &base_name );
     for (entry = mark->Flink; entry != mark; entry = entry->Flink)
     {
-        LDR_DATA_TABLE_ENTRY *mod = CONTAINING_RECORD(entry, LDR_DATA_TABLE_ENTRY, InLoadOrderLinks);
-        if (RtlEqualUnicodeString( &name, &mod->FullDllName, TRUE ))
+        WINE_MODREF *wm = CONTAINING_RECORD( entry, WINE_MODREF, hash_links );
+        if (RtlEqualUnicodeString( &name, &wm->ldr.FullDllName, TRUE ))
         {
-            cached_modref = CONTAINING_RECORD(mod, WINE_MODREF, ldr);
+            cached_modref = wm;
             return cached_modref;
         }
     }
@@ -1195,6 +1229,7 @@ static WINE_MODREF *alloc_module( HMODULE hModule, const UNICODE_STRING *nt_name
                    &wm->ldr.InLoadOrderLinks);
     InsertTailList(&NtCurrentTeb()->Peb->LdrData->InMemoryOrderModuleList,
                    &wm->ldr.InMemoryOrderLinks);
+    InsertTailList( hash_basename( &wm->ldr.BaseDllName ), &wm->hash_links );
     /* wait until init is called for inserting into InInitializationOrderModuleList */
 
     if (!(nt->OptionalHeader.DllCharacteristics & IMAGE_DLLCHARACTERISTICS_NX_COMPAT))
@@ -1902,6 +1937,7 @@ static NTSTATUS build_module( LPCWSTR load_path, const UNICODE_STRING *nt_name,
             /* the module has only be inserted in the load & memory order lists */
             RemoveEntryList(&wm->ldr.InLoadOrderLinks);
             RemoveEntryList(&wm->ldr.InMemoryOrderLinks);
+            RemoveEntryList(&wm->hash_links);
 
             /* FIXME: there are several more dangling references
              * left. Including dlls loaded by this dll before the
@@ -2266,7 +2302,7 @@ static NTSTATUS open_dll_file( UNICODE_STRING *nt_name, WINE_MODREF **pwm, HANDL
             return status;
         }
         /* otherwise continue searching */
-        return STATUS_DLL_NOT_FOUND;
+        return status == STATUS_OBJECT_PATH_NOT_FOUND ? status : STATUS_DLL_NOT_FOUND;
     }
 
     if (!NtFsControlFile( handle, 0, NULL, NULL, &io, FSCTL_GET_OBJECT_ID, NULL, 0, &fid, sizeof(fid) ))
@@ -2488,6 +2524,115 @@ done:
 }
 
 
+/***********************************************************************
+ *	get_dir_attributes
+ *
+ * Query the attributes of the first len characters of a dos path.
+ */
+static NTSTATUS get_dir_attributes( const WCHAR *dir, ULONG len, FILE_BASIC_INFORMATION *info )
+{
+    OBJECT_ATTRIBUTES attr;
+    UNICODE_STRING nt_name;
+    WCHAR *path;
+    NTSTATUS status;
+
+    if (!(path = RtlAllocateHeap( GetProcessHeap(), 0, (len + 1) * sizeof(WCHAR) ))) return STATUS_NO_MEMORY;
+    memcpy( path, dir, len * sizeof(WCHAR) );
+    path[len] = 0;
+    status = RtlDosPathNameToNtPathName_U_WithStatus( path, &nt_name, NULL, NULL );
+    RtlFreeHeap( GetProcessHeap(), 0, path );
+    if (status) return status;
+
+    attr.Length = sizeof(attr);
+    attr.RootDirectory = 0;
+    attr.Attributes = OBJ_CASE_INSENSITIVE;
+    attr.ObjectName = &nt_name;
+    attr.SecurityDescriptor = NULL;
+    attr.SecurityQualityOfService = NULL;
+    status = NtQueryAttributesFile( &attr, info );
+    RtlFreeUnicodeString( &nt_name );
+    return status;
+}
+
+
+/***********************************************************************
+ *	get_parent_dir_time
+ *
+ * Get the last write time of the parent of a directory of the search path.
+ */
+static BOOL get_parent_dir_time( const WCHAR *dir, ULONG len, LARGE_INTEGER *time )
+{
+    FILE_BASIC_INFORMATION info;
+
+    if (RtlDetermineDosPathNameType_U( dir ) != ABSOLUTE_DRIVE_PATH) return FALSE;
+
+    for (len--; len > 2; len--) if (dir[len - 1] == '\\') break;
+    if (len <= 2) return FALSE;  /* root directory */
+    if (len > 3) len--;  /* strip trailing backslash */
+
+    if (get_dir_attributes( dir, len, &info )) return FALSE;
+    *time = info.LastWriteTime;
+    return TRUE;
+}
+
+
+/***********************************************************************
+ *	is_missing_dir
+ *
+ * Check if a directory of the search path is known not to exist. The entry
+ * is dropped once the parent directory has been modified.
+ * The loader_section must be locked while calling this function.
+ */
+static BOOL is_missing_dir( const WCHAR *dir, ULONG len )
+{
+    struct missing_dir *missing;
+    LARGE_INTEGER time;
+
+    LIST_FOR_EACH_ENTRY( missing, &missing_dirs, struct missing_dir, entry )
+    {
+        if (missing->len != len || wcsnicmp( missing->dir, dir, len )) continue;
+        if (get_parent_dir_time( missing->dir, len, &time ) &&
+            time.QuadPart == missing->parent_time.QuadPart) return TRUE;
+        list_remove( &missing->entry );
+        RtlFreeHeap( GetProcessHeap(), 0, missing );
+        return FALSE;
+    }
+    return FALSE;
+}
+
+
+/***********************************************************************
+ *	add_missing_dir
+ *
+ * Remember that a directory of the search path doesn't exist.
+ * The loader_section must be locked while calling this function.
+ */
+static void add_missing_dir( const WCHAR *dir, ULONG len )
+{
+    struct missing_dir *missing;
+    FILE_BASIC_INFORMATION info;
+    LARGE_INTEGER time;
+    NTSTATUS status;
+
+    /* get the parent time first, so that a directory created after the
+     * check below invalidates the entry */
+    if (!get_parent_dir_time( dir, len, &time )) return;
+
+    /* the missing component may be a subdirectory of the dll name */
+    status = get_dir_attributes( dir, len - 1, &info );
+    if (status != STATUS_OBJECT_NAME_NOT_FOUND && status != STATUS_OBJECT_PATH_NOT_FOUND) return;
+
+    if (!(missing = RtlAllocateHeap( GetProcessHeap(), 0, offsetof( struct missing_dir, dir[len + 1] ))))
+        return;
+    memcpy( missing->dir, dir, len * sizeof(WCHAR) );
+    missing->dir[len] = 0;
+    missing->len = len;
+    missing->parent_time = time;
+    TRACE( "%s\n", debugstr_w(missing->dir) );
+    list_add_tail( &missing_dirs, &missing->entry );
+}
+
+
 /***********************************************************************
  *	search_dll_file
  *
@@ -2518,15 +2663,22 @@ static NTSTATUS search_dll_file( LPCWSTR paths, LPCWSTR search, UNICODE_STRING *
         memcpy( name, paths, len * sizeof(WCHAR) );
         if (len && name[len - 1] != '\\') name[len++] = '\\';
         wcscpy( name + len, search );
+        paths = ptr;
+
+        if (is_missing_dir( name, len )) continue;
 
         nt_name->Buffer = NULL;
         if ((status = RtlDosPathNameToNtPathName_U_WithStatus( name, nt_name, NULL, NULL ))) goto done;
 
         status = open_dll_file( nt_name, pwm, mapping, image_info, id );
+        if (status == STATUS_OBJECT_PATH_NOT_FOUND)
+        {
+            add_missing_dir( name, len );
+            status = STATUS_DLL_NOT_FOUND;
+        }
         if (status == STATUS_IMAGE_MACHINE_TYPE_MISMATCH) found_image = TRUE;
         else if (status != STATUS_DLL_NOT_FOUND) goto done;
         RtlFreeUnicodeString( nt_name );
-        paths = ptr;
     }
 
     if (!found_image)
@@ -2603,7 +2755,10 @@ static NTSTATUS find_dll_file( const WCHAR *load_path, const WCHAR *libname, con
     if (RtlDetermineDosPathNameType_U( libname ) == RELATIVE_PATH)
         status = search_dll_file( load_path, libname, nt_name, pwm, mapping, image_info, id );
     else if (!(status = RtlDosPathNameToNtPathName_U_WithStatus( libname, nt_name, NULL, NULL )))
+    {
         status = open_dll_file( nt_name, pwm, mapping, image_info, id );
+        if (status == STATUS_OBJECT_PATH_NOT_FOUND) status = STATUS_DLL_NOT_FOUND;
+    }
 
     if (status == STATUS_IMAGE_MACHINE_TYPE_MISMATCH) status = STATUS_INVALID_IMAGE_FORMAT;
 
@@ -3265,6 +3420,7 @@ static void free_modref( WINE_MODREF *wm )
 {
     RemoveEntryList(&wm->ldr.InLoadOrderLinks);
     RemoveEntryList(&wm->ldr.InMemoryOrderLinks);
+    RemoveEntryList(&wm->hash_links);
     if (wm->ldr.InInitializationOrderLinks.Flink)
         RemoveEntryList(&wm->ldr.InInitializationOrderLinks);
 
@@ -3963,6 +4119,7 @@ static NTSTATUS process_init(void)
     INITIAL_TEB stack;
     TEB *teb = NtCurrentTeb();
     PEB *peb = teb->Peb;
+    ULONG i;
 
     peb->LdrData            = &ldr;
     peb->FastPebLock        = &peb_lock;
@@ -3985,6 +4142,7 @@ static NTSTATUS process_init(void)
     InitializeListHead( &ldr.InLoadOrderModuleList );
     InitializeListHead( &ldr.InMemoryOrderModuleList );
     InitializeListHead( &ldr.InInitializationOrderModuleList );
+    for (i = 0; i < HASH_MAP_SIZE; i++) InitializeListHead( &hash_table[i] );
 
 #ifndef _WIN64
     is_wow64 = !!NtCurrentTeb64();
@@ -2576,7 +2576,8 @@ static void test_dynamic_unwind(void)
 {
     static const int code_offset = 1024;
     char buf[2 * sizeof(RUNTIME_FUNCTION) + 4];
-    RUNTIME_FUNCTION *runtime_func, *func;
+    RUNTIME_FUNCTION *runtime_func, *func, history_func;
+    UNWIND_HISTORY_TABLE history;
     ULONG_PTR table, base;
     void *growable_table;
     NTSTATUS status;
@@ -2606,6 +2607,31 @@ static void test_dynamic_unwind(void)
     ok( base == (ULONG_PTR)code_mem,
         "RtlLookupFunctionEntry returned invalid base, expected: %lx, got: %lx\n", (ULONG_PTR)code_mem, base );
 
+    /* Test lookup in a history table in search mode */
+    ok( FIELD_OFFSET(UNWIND_HISTORY_TABLE, Search) == 6, "got offset %u\n",
+        FIELD_OFFSET(UNWIND_HISTORY_TABLE, Search) );
+    history_func = *runtime_func;
+    memset( &history, 0, sizeof(history) );
+    history.Count = 1;
+    history.Search = UNWIND_HISTORY_TABLE_GLOBAL;
+    history.LowAddress = (ULONG_PTR)code_mem + code_offset;
+    history.HighAddress = (ULONG_PTR)code_mem + code_offset + 16;
+    history.Entry[0].ImageBase = (ULONG_PTR)code_mem;
+    history.Entry[0].FunctionEntry = &history_func;
+    base = 0xdeadbeef;
+    func = pRtlLookupFunctionEntry( (ULONG_PTR)code_mem + code_offset + 8, &base, &history );
+    ok( func == &history_func,
+        "RtlLookupFunctionEntry didn't return expected function, expected: %p, got: %p\n", &history_func, func );
+    ok( base == (ULONG_PTR)code_mem,
+        "RtlLookupFunctionEntry returned invalid base, expected: %lx, got: %lx\n", (ULONG_PTR)code_mem, base );
+
+    /* Addresses outside of the table range use the function tables */
+    history.HighAddress = (ULONG_PTR)code_mem + code_offset + 4;
+    base = 0xdeadbeef;
+    func = pRtlLookupFunctionEntry( (ULONG_PTR)code_mem + code_offset + 8, &base, &history );
+    ok( func == runtime_func,
+        "RtlLookupFunctionEntry didn't return expected function, expected: %p, got: %p\n", runtime_func, func );
+
     /* Test RtlDeleteFunctionTable */
     ok( pRtlDeleteFunctionTable( runtime_func ),
         "RtlDeleteFunctionTable failed for runtime_func = %p (aligned)\n", runtime_func );
@@ -1968,14 +1968,23 @@ static void tp_object_submit( struct threadpool_object *object, BOOL signaled )
     if (object->type == TP_OBJECT_TYPE_WAIT && signaled)
         object->u.wait.signaled++;
 
-    /* No new thread started - wake up one existing thread. */
+    assert( status == STATUS_SUCCESS || pool->num_workers > 0 );
+
+    /* Keep the pool alive until the wakeup below, the object may be
+     * released by a worker as soon as the lock is dropped. */
+    if (status != STATUS_SUCCESS)
+        InterlockedIncrement( &pool->refcount );
+
+    RtlLeaveCriticalSection( &pool->cs );
+
+    /* No new thread started - wake up one existing thread. This is done after
+     * leaving the critical section, so that the woken thread doesn't have to
+     * wait for it to be released. */
     if (status != STATUS_SUCCESS)
     {
-        assert( pool->num_workers > 0 );
         RtlWakeConditionVariable( &pool->update_event );
+        tp_threadpool_release( pool );
     }
-
-    RtlLeaveCriticalSection( &pool->cs );
 }
 
 /***********************************************************************
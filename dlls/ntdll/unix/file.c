@@ -58,6 +58,9 @@
 #ifdef HAVE_SYS_TIME_H
 # include <sys/time.h>
 #endif
+#ifdef HAVE_SYS_UIO_H
+# include <sys/uio.h>
+#endif
 #ifdef HAVE_SYS_ATTR_H
 #include <sys/attr.h>
 #endif
@@ -1496,8 +1499,10 @@ static int fd_get_file_info( int fd, unsigned int options, struct stat *st, ULON
 }
 
 
-/* get the stat info and file attributes for a file (by name) */
-static int get_file_info( const char *path, struct stat *st, ULONG *attr )
+/* get the stat info and file attributes for a file (by name)
+ * parent is the identity of the containing directory if already known */
+static int get_file_info( const char *path, const struct file_identity *parent,
+                          struct stat *st, ULONG *attr )
 {
     char *parent_path;
     int ret;
@@ -1512,6 +1517,12 @@ static int get_file_info( const char *path, struct stat *st, ULONG *attr )
         /* is a symbolic link and a directory, consider these "reparse points" */
         if (S_ISDIR( st->st_mode )) *attr |= FILE_ATTRIBUTE_REPARSE_POINT;
     }
+    else if (S_ISDIR( st->st_mode ) && parent)
+    {
+        /* consider mount points to be reparse points (IO_REPARSE_TAG_MOUNT_POINT) */
+        if (st->st_dev != parent->dev || st->st_ino == parent->ino)
+            *attr |= FILE_ATTRIBUTE_REPARSE_POINT;
+    }
     else if (S_ISDIR( st->st_mode ) && (parent_path = malloc( strlen(path) + 4 )))
     {
         struct stat parent_st;
@@ -2000,11 +2011,14 @@ static NTSTATUS get_dir_data_entry( struct dir_data *dir_data, void *info_ptr, I
                                     union file_directory_info **last_info )
 {
     const struct dir_data_names *names = &dir_data->names[dir_data->pos];
+    const struct file_identity *parent = &dir_data->id;
     union file_directory_info *info;
     struct stat st;
     ULONG name_len, start, dir_size, attributes;
 
-    if (get_file_info( names->unix_name, &st, &attributes ) == -1)
+    /* the current directory is the parent of all entries except "." and ".." */
+    if (!strcmp( names->unix_name, "." ) || !strcmp( names->unix_name, ".." )) parent = NULL;
+    if (get_file_info( names->unix_name, parent, &st, &attributes ) == -1)
     {
         TRACE( "file no longer exists %s\n", names->unix_name );
         return STATUS_SUCCESS;
@@ -2474,6 +2488,73 @@ NTSTATUS WINAPI NtQueryDirectoryFile( HANDLE handle, HANDLE event, PIO_APC_ROUTI
 }
 
 
+/* cache of the results of recent case-insensitive directory searches */
+#define DIR_LOOKUP_CACHE_SIZE 128
+#define DIR_LOOKUP_MAX_NAME   64
+
+struct dir_lookup
+{
+    dev_t  dev;                                  /* device of the directory */
+    ino_t  ino;                                  /* inode of the directory */
+    time_t mtime;                                /* modification time of the directory */
+    int    length;                               /* length of the dos name, 0 if entry is unused */
+    WCHAR  name[DIR_LOOKUP_MAX_NAME];            /* dos name that was searched for */
+    char   unix_name[DIR_LOOKUP_MAX_NAME * 3];   /* matching unix name, empty if not found */
+};
+
+static pthread_mutex_t dir_lookup_mutex = PTHREAD_MUTEX_INITIALIZER;
+static struct dir_lookup dir_lookup_cache[DIR_LOOKUP_CACHE_SIZE];
+
+static struct dir_lookup *get_dir_lookup_entry( const struct stat *st, const WCHAR *name, int length )
+{
+    unsigned int i, hash = st->st_ino;
+
+    for (i = 0; i < length; i++) hash = hash * 65599 + towupper( name[i] );
+    return &dir_lookup_cache[hash % DIR_LOOKUP_CACHE_SIZE];
+}
+
+/* look for a previous search result; returns -1 if unknown, otherwise whether the file exists */
+static int get_cached_dir_lookup( const struct stat *st, const WCHAR *name, int length, char *unix_name )
+{
+    struct dir_lookup *entry;
+    int ret = -1;
+
+    if (length > DIR_LOOKUP_MAX_NAME) return -1;
+
+    mutex_lock( &dir_lookup_mutex );
+    entry = get_dir_lookup_entry( st, name, length );
+    if (entry->length == length && entry->dev == st->st_dev && entry->ino == st->st_ino &&
+        entry->mtime == st->st_mtime && !wcsnicmp( entry->name, name, length ))
+    {
+        strcpy( unix_name, entry->unix_name );
+        ret = unix_name[0] != 0;
+    }
+    mutex_unlock( &dir_lookup_mutex );
+    return ret;
+}
+
+/* store the result of a search; unix_name is NULL if the file wasn't found */
+static void set_cached_dir_lookup( const struct stat *st, const WCHAR *name, int length, const char *unix_name )
+{
+    struct dir_lookup *entry;
+
+    if (length > DIR_LOOKUP_MAX_NAME) return;
+    if (unix_name && strlen( unix_name ) >= sizeof(entry->unix_name)) return;
+    /* the directory could still be modified without changing its timestamp */
+    if (st->st_mtime >= time( NULL ) - 1) return;
+
+    mutex_lock( &dir_lookup_mutex );
+    entry = get_dir_lookup_entry( st, name, length );
+    entry->dev = st->st_dev;
+    entry->ino = st->st_ino;
+    entry->mtime = st->st_mtime;
+    entry->length = length;
+    memcpy( entry->name, name, length * sizeof(WCHAR) );
+    strcpy( entry->unix_name, unix_name ? unix_name : "" );
+    mutex_unlock( &dir_lookup_mutex );
+}
+
+
 /***********************************************************************
  *           find_file_in_dir
  *
@@ -2485,10 +2566,10 @@ static NTSTATUS find_file_in_dir( char *unix_name, int pos, const WCHAR *name, i
                                   BOOLEAN check_case, BOOLEAN *is_win_dir )
 {
     WCHAR buffer[MAX_DIR_ENTRY_LEN];
-    BOOLEAN is_name_8_dot_3;
+    BOOLEAN is_name_8_dot_3, use_cache = FALSE;
     DIR *dir;
     struct dirent *de;
-    struct stat st;
+    struct stat st, dir_st;
     int ret;
 
     /* try a shortcut for this directory */
@@ -2518,6 +2599,21 @@ static NTSTATUS find_file_in_dir( char *unix_name, int pos, const WCHAR *name, i
 
     if (!is_name_8_dot_3 && !get_dir_case_sensitivity( unix_name )) goto not_found;
 
+    /* check if we already searched this directory for the same name */
+
+    if (!stat( unix_name, &dir_st ))
+    {
+        switch (get_cached_dir_lookup( &dir_st, name, length, unix_name + pos ))
+        {
+        case 0:
+            goto not_found;
+        case 1:
+            unix_name[pos - 1] = '/';
+            goto success;
+        }
+        use_cache = TRUE;
+    }
+
     /* now look for it through the directory */
 
 #ifdef VFAT_IOCTL_READDIR_BOTH
@@ -2599,9 +2695,11 @@ static NTSTATUS find_file_in_dir( char *unix_name, int pos, const WCHAR *name, i
 
 not_found:
     unix_name[pos - 1] = 0;
+    if (use_cache) set_cached_dir_lookup( &dir_st, name, length, NULL );
     return STATUS_OBJECT_PATH_NOT_FOUND;
 
 success:
+    if (use_cache) set_cached_dir_lookup( &dir_st, name, length, unix_name + pos );
     if (is_win_dir && !stat( unix_name, &st )) *is_win_dir = is_same_file( &windir, &st );
     return STATUS_SUCCESS;
 }
@@ -3781,7 +3879,7 @@ NTSTATUS WINAPI NtQueryFullAttributesFile( const OBJECT_ATTRIBUTES *attr,
         ULONG attributes;
         struct stat st;
 
-        if (get_file_info( unix_name, &st, &attributes ) == -1)
+        if (get_file_info( unix_name, NULL, &st, &attributes ) == -1)
             status = errno_to_status( errno );
         else if (!S_ISREG(st.st_mode) && !S_ISDIR(st.st_mode))
             status = STATUS_INVALID_INFO_CLASS;
@@ -3822,7 +3920,7 @@ NTSTATUS WINAPI NtQueryAttributesFile( const OBJECT_ATTRIBUTES *attr, FILE_BASIC
         ULONG attributes;
         struct stat st;
 
-        if (get_file_info( unix_name, &st, &attributes ) == -1)
+        if (get_file_info( unix_name, NULL, &st, &attributes ) == -1)
             status = errno_to_status( errno );
         else if (!S_ISREG(st.st_mode) && !S_ISDIR(st.st_mode))
             status = STATUS_INVALID_INFO_CLASS;
@@ -4066,7 +4164,7 @@ NTSTATUS WINAPI NtQueryInformationFile( HANDLE handle, IO_STATUS_BLOCK *io,
                 ULONG attributes;
                 struct stat st;
 
-                if (get_file_info( unix_name, &st, &attributes ) == -1)
+                if (get_file_info( unix_name, NULL, &st, &attributes ) == -1)
                     io->u.Status = errno_to_status( errno );
                 else if (!S_ISREG(st.st_mode) && !S_ISDIR(st.st_mode))
                     io->u.Status = STATUS_INVALID_INFO_CLASS;
@@ -5180,6 +5278,27 @@ err:
 }
 
 
+/* maximum number of segments transferred in a single system call */
+#define MAX_SEGMENT_IOVECS 64
+
+/* fill the iovec array with the remaining page segments of a scatter/gather request */
+static int get_segment_iovecs( struct iovec *iov, const FILE_SEGMENT_ELEMENT *segments,
+                               ULONG pos, ULONG length )
+{
+    int count = 0;
+
+    while (length && count < MAX_SEGMENT_IOVECS)
+    {
+        iov[count].iov_base = (char *)segments[count].Buffer + pos;
+        iov[count].iov_len = min( length, page_size - pos );
+        length -= iov[count].iov_len;
+        pos = 0;
+        count++;
+    }
+    return count;
+}
+
+
 /******************************************************************************
  *              NtReadFileScatter   (NTDLL.@)
  */
@@ -5187,10 +5306,11 @@ NTSTATUS WINAPI NtReadFileScatter( HANDLE file, HANDLE event, PIO_APC_ROUTINE ap
                                    IO_STATUS_BLOCK *io, FILE_SEGMENT_ELEMENT *segments,
                                    ULONG length, LARGE_INTEGER *offset, ULONG *key )
 {
-    int result, unix_handle, needs_close;
+    int result, unix_handle, needs_close, count;
     unsigned int options;
     NTSTATUS status;
     ULONG pos = 0, total = 0;
+    struct iovec iov[MAX_SEGMENT_IOVECS];
     enum server_fd_type type;
     ULONG_PTR cvalue = apc ? 0 : (ULONG_PTR)apc_user;
     BOOL send_completion = FALSE;
@@ -5213,11 +5333,15 @@ NTSTATUS WINAPI NtReadFileScatter( HANDLE file, HANDLE event, PIO_APC_ROUTINE ap
 
     while (length)
     {
+        count = get_segment_iovecs( iov, segments, pos, length );
         if (offset && offset->QuadPart != FILE_USE_FILE_POINTER_POSITION)
-            result = pread( unix_handle, (char *)segments->Buffer + pos,
-                            min( length - pos, page_size - pos ), offset->QuadPart + total );
+#ifdef HAVE_PREADV
+            result = preadv( unix_handle, iov, count, offset->QuadPart + total );
+#else
+            result = pread( unix_handle, iov[0].iov_base, iov[0].iov_len, offset->QuadPart + total );
+#endif
         else
-            result = read( unix_handle, (char *)segments->Buffer + pos, min( length - pos, page_size - pos ) );
+            result = readv( unix_handle, iov, count );
 
         if (result == -1)
         {
@@ -5228,11 +5352,9 @@ NTSTATUS WINAPI NtReadFileScatter( HANDLE file, HANDLE event, PIO_APC_ROUTINE ap
         if (!result) break;
         total += result;
         length -= result;
-        if ((pos += result) == page_size)
-        {
-            pos = 0;
-            segments++;
-        }
+        pos += result;
+        segments += pos / page_size;
+        pos %= page_size;
     }
 
     if (total == 0) status = STATUS_END_OF_FILE;
@@ -5489,10 +5611,11 @@ NTSTATUS WINAPI NtWriteFileGather( HANDLE file, HANDLE event, PIO_APC_ROUTINE ap
                                    IO_STATUS_BLOCK *io, FILE_SEGMENT_ELEMENT *segments,
                                    ULONG length, LARGE_INTEGER *offset, ULONG *key )
 {
-    int result, unix_handle, needs_close;
+    int result, unix_handle, needs_close, count;
     unsigned int options;
     NTSTATUS status;
     ULONG pos = 0, total = 0;
+    struct iovec iov[MAX_SEGMENT_IOVECS];
     enum server_fd_type type;
     ULONG_PTR cvalue = apc ? 0 : (ULONG_PTR)apc_user;
     BOOL send_completion = FALSE;
@@ -5516,11 +5639,15 @@ NTSTATUS WINAPI NtWriteFileGather( HANDLE file, HANDLE event, PIO_APC_ROUTINE ap
 
     while (length)
     {
+        count = get_segment_iovecs( iov, segments, pos, length );
         if (offset && offset->QuadPart != FILE_USE_FILE_POINTER_POSITION)
-            result = pwrite( unix_handle, (char *)segments->Buffer + pos,
-                             page_size - pos, offset->QuadPart + total );
+#ifdef HAVE_PWRITEV
+            result = pwritev( unix_handle, iov, count, offset->QuadPart + total );
+#else
+            result = pwrite( unix_handle, iov[0].iov_base, iov[0].iov_len, offset->QuadPart + total );
+#endif
         else
-            result = write( unix_handle, (char *)segments->Buffer + pos, page_size - pos );
+            result = writev( unix_handle, iov, count );
 
         if (result == -1)
         {
@@ -5540,11 +5667,9 @@ NTSTATUS WINAPI NtWriteFileGather( HANDLE file, HANDLE event, PIO_APC_ROUTINE ap
         }
         total += result;
         length -= result;
-        if ((pos += result) == page_size)
-        {
-            pos = 0;
-            segments++;
-        }
+        pos += result;
+        segments += pos / page_size;
+        pos %= page_size;
     }
 
     send_completion = cvalue != 0;
@@ -127,12 +127,12 @@ static inline int futex_wake( const int *addr, int val )
     return syscall( __NR_futex, addr, FUTEX_WAKE | futex_private, val, NULL, 0, 0 );
 }
 
-static inline int futex_wait_bitset( const int *addr, int val, struct timespec *timeout, int mask )
+static inline int futex_wait_bitset( const int *addr, int val, struct timespec *timeout, unsigned int mask )
 {
     return syscall( __NR_futex, addr, FUTEX_WAIT_BITSET | futex_private, val, timeout, 0, mask );
 }
 
-static inline int futex_wake_bitset( const int *addr, int val, int mask )
+static inline int futex_wake_bitset( const int *addr, int val, unsigned int mask )
 {
     return syscall( __NR_futex, addr, FUTEX_WAKE_BITSET | futex_private, val, NULL, 0, mask );
 }
@@ -2686,14 +2686,18 @@ NTSTATUS CDECL fast_RtlWakeConditionVariable( RTL_CONDITION_VARIABLE *variable,
 /* We can't map addresses to futex directly, because an application can wait on
  * 8 bytes, and we can't pass all 8 as the compare value to futex(). Instead we
  * map all addresses to a small fixed table of futexes. This may result in
- * spurious wakes, but the application is already expected to handle those. */
+ * spurious wakes, but the application is already expected to handle those.
+ * To limit them, waiters also pass a futex bitset derived from more bits of
+ * the address, so that a wake only affects the waiters whose address maps to
+ * the same bit of the same futex. */
 
 static int addr_futex_table[256];
 
-static inline int *hash_addr( const void *addr )
+static inline int *hash_addr( const void *addr, unsigned int *mask )
 {
     ULONG_PTR val = (ULONG_PTR)addr;
 
+    *mask = 1u << ((val >> 10) & 31);
     return &addr_futex_table[(val >> 2) & 255];
 }
 
@@ -2702,13 +2706,14 @@ static inline NTSTATUS fast_wait_addr( const void *addr, const void *cmp, SIZE_T
 {
     int *futex;
     int val;
-    struct timespec timespec;
+    unsigned int mask;
+    struct timespec timespec, now;
     int ret;
 
     if (!use_futexes())
         return STATUS_NOT_IMPLEMENTED;
 
-    futex = hash_addr( addr );
+    futex = hash_addr( addr, &mask );
 
     /* We must read the previous value of the futex before checking the value
      * of the address being waited on. That way, if we receive a wake between
@@ -2721,11 +2726,20 @@ static inline NTSTATUS fast_wait_addr( const void *addr, const void *cmp, SIZE_T
 
     if (timeout)
     {
+        /* the bitset wait uses an absolute monotonic timeout */
         timespec_from_timeout( &timespec, timeout );
-        ret = futex_wait( futex, val, &timespec );
+        clock_gettime( CLOCK_MONOTONIC, &now );
+        timespec.tv_sec += now.tv_sec;
+        timespec.tv_nsec += now.tv_nsec;
+        if (timespec.tv_nsec >= 1000000000)
+        {
+            timespec.tv_nsec -= 1000000000;
+            timespec.tv_sec++;
+        }
+        ret = futex_wait_bitset( futex, val, &timespec, mask );
     }
     else
-        ret = futex_wait( futex, val, NULL );
+        ret = futex_wait_bitset( futex, val, NULL, mask );
 
     if (ret == -1 && errno == ETIMEDOUT)
         return STATUS_TIMEOUT;
@@ -2735,15 +2749,16 @@ static inline NTSTATUS fast_wait_addr( const void *addr, const void *cmp, SIZE_T
 static inline NTSTATUS fast_wake_addr( const void *addr )
 {
     int *futex;
+    unsigned int mask;
 
     if (!use_futexes())
         return STATUS_NOT_IMPLEMENTED;
 
-    futex = hash_addr( addr );
+    futex = hash_addr( addr, &mask );
 
     InterlockedIncrement( futex );
 
-    futex_wake( futex, INT_MAX );
+    futex_wake_bitset( futex, INT_MAX, mask );
     return STATUS_SUCCESS;
 }
 
@@ -1993,6 +1993,21 @@ static NTSTATUS map_pe_header( void *ptr, size_t size, int fd, BOOL *removable )
 }
 
 
+/***********************************************************************
+ *           clear_image_range
+ *
+ * Clear the unused end of a mapped image page. The page is only written to
+ * if it contains non-zero data, so that it can remain shared with the file.
+ */
+static void clear_image_range( char *ptr, size_t size )
+{
+    const char *p = ptr, *end = ptr + size;
+
+    while (p < end && !*p) p++;
+    if (p < end) memset( ptr, 0, size );
+}
+
+
 /***********************************************************************
  *           map_image_into_view
  *
@@ -2027,7 +2042,7 @@ static NTSTATUS map_image_into_view( struct file_view *view, int fd, void *orig_
     dos = (IMAGE_DOS_HEADER *)ptr;
     nt = (IMAGE_NT_HEADERS *)(ptr + dos->e_lfanew);
     header_end = ptr + ROUND_SIZE( 0, header_size );
-    memset( ptr + header_size, 0, header_end - (ptr + header_size) );
+    clear_image_range( ptr + header_size, header_end - (ptr + header_size) );
     if ((char *)(nt + 1) > header_end) return status;
     header_start = (char*)&nt->OptionalHeader+nt->FileHeader.SizeOfOptionalHeader;
     if (nt->FileHeader.NumberOfSections > ARRAY_SIZE( sections )) return status;
@@ -2152,7 +2167,7 @@ static NTSTATUS map_image_into_view( struct file_view *view, int fd, void *orig_
             TRACE_(module)("clearing %p - %p\n",
                            ptr + sec->VirtualAddress + file_size,
                            ptr + sec->VirtualAddress + end );
-            memset( ptr + sec->VirtualAddress + file_size, 0, end - file_size );
+            clear_image_range( ptr + sec->VirtualAddress + file_size, end - file_size );
         }
     }
 
@@ -413,6 +413,7 @@ static HRESULT adapter_vk_create_device(struct wined3d *wined3d, const struct wi
     VkPhysicalDeviceFeatures2 *features2;
     struct wined3d_device_vk *device_vk;
     VkDevice vk_device = VK_NULL_HANDLE;
+    VkPipelineCacheCreateInfo cache_info;
     VkDeviceQueueCreateInfo queue_info;
     VkPhysicalDevice physical_device;
     VkDeviceCreateInfo device_info;
@@ -509,10 +510,25 @@ static HRESULT adapter_vk_create_device(struct wined3d *wined3d, const struct wi
         goto fail;
     }
 
+    /* Pipelines for different state combinations of the same shaders can
+     * share most of the compilation work. Failure to create the cache is not
+     * fatal; pipelines are created without one in that case. */
+    cache_info.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    cache_info.pNext = NULL;
+    cache_info.flags = 0;
+    cache_info.initialDataSize = 0;
+    cache_info.pInitialData = NULL;
+    if ((vr = VK_CALL(vkCreatePipelineCache(vk_device, &cache_info, NULL, &device_vk->vk_pipeline_cache))) < 0)
+    {
+        WARN("Failed to create Vulkan pipeline cache, vr %s.\n", wined3d_debug_vkresult(vr));
+        device_vk->vk_pipeline_cache = VK_NULL_HANDLE;
+    }
+
     if (FAILED(hr = wined3d_device_init(&device_vk->d, wined3d, adapter->ordinal, device_type, focus_window,
             flags, surface_alignment, levels, level_count, vk_info->supported, device_parent)))
     {
         WARN("Failed to initialize device, hr %#x.\n", hr);
+        VK_CALL(vkDestroyPipelineCache(vk_device, device_vk->vk_pipeline_cache, NULL));
         wined3d_allocator_cleanup(&device_vk->allocator);
         goto fail;
     }
@@ -533,6 +549,7 @@ static void adapter_vk_destroy_device(struct wined3d_device *device)
     const struct wined3d_vk_info *vk_info = &device_vk->vk_info;
 
     wined3d_device_cleanup(&device_vk->d);
+    VK_CALL(vkDestroyPipelineCache(device_vk->vk_device, device_vk->vk_pipeline_cache, NULL));
     wined3d_allocator_cleanup(&device_vk->allocator);
     VK_CALL(vkDestroyDevice(device_vk->vk_device, NULL));
     heap_free(device_vk);
@@ -2675,6 +2675,20 @@ static void *wined3d_bo_gl_map(struct wined3d_bo_gl *bo,
 
     if ((flags & WINED3D_MAP_DISCARD) && bo->command_fence_id > device_gl->completed_fence_id)
     {
+        gl_info = context_gl->gl_info;
+
+        /* Without immutable storage we can simply orphan the old storage.
+         * This keeps the buffer name, so existing bindings and views remain
+         * valid. */
+        if (!gl_info->supported[ARB_BUFFER_STORAGE])
+        {
+            wined3d_context_gl_bind_bo(context_gl, bo->binding, bo->id);
+            GL_EXTCALL(glBufferData(bo->binding, bo->size, NULL, bo->usage));
+            checkGLcall("buffer object orphaning");
+            bo->command_fence_id = 0;
+            goto map;
+        }
+
         if (wined3d_context_gl_create_bo(context_gl, bo->size,
                 bo->binding, bo->usage, bo->coherent, bo->flags, &tmp))
         {
@@ -2810,6 +2810,7 @@ static void *wined3d_cs_queue_require_space(struct wined3d_cs_queue *queue, size
 
         TRACE("Waiting for free space. Head %u, tail %u, packet size %lu.\n",
                 head, tail, (unsigned long)packet_size);
+        YieldProcessor();
     }
 
     packet = (struct wined3d_cs_packet *)&queue->data[queue->head];
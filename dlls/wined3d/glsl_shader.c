@@ -130,6 +130,8 @@ struct shader_glsl_priv
     struct wined3d_string_buffer shader_buffer;
     struct wined3d_string_buffer_list string_buffers;
     struct wine_rb_tree program_lookup;
+    struct wine_rb_tree vs3_input_setup_shaders;
+    unsigned int vs3_input_setup_shader_count;
     struct constant_heap vconst_heap;
     struct constant_heap pconst_heap;
     unsigned char *stack;
@@ -334,6 +336,18 @@ struct glsl_shader_private
     unsigned int num_gl_shaders, shader_array_size;
 };
 
+/* Rasterizer input setup shaders only depend on the vertex shader outputs
+ * and pixel shader inputs, so the same source tends to be generated for many
+ * different programs. Compiled shaders are kept around and reused. */
+#define WINED3D_GLSL_MAX_VS3_INPUT_SETUP_SHADERS 256
+
+struct glsl_vs3_input_setup_shader
+{
+    struct wine_rb_entry entry;
+    GLuint id;
+    char source[1];
+};
+
 struct glsl_ffp_vertex_shader
 {
     struct wined3d_ffp_vs_desc desc;
@@ -7101,15 +7115,18 @@ static void shader_glsl_setup_sm3_rasterizer_input(struct shader_glsl_priv *priv
 /* Context activation is done by the caller. */
 static GLuint shader_glsl_generate_vs3_rasterizer_input_setup(struct shader_glsl_priv *priv,
         const struct wined3d_shader *vs, const struct wined3d_shader *ps,
-        BOOL per_vertex_point_size, BOOL flatshading, const struct wined3d_gl_info *gl_info)
+        BOOL per_vertex_point_size, BOOL flatshading, const struct wined3d_gl_info *gl_info, BOOL *cached)
 {
     const BOOL legacy_syntax = needs_legacy_glsl_syntax(gl_info);
     DWORD ps_major = ps ? ps->reg_maps.shader_version.major : 0;
     struct wined3d_string_buffer *buffer = &priv->shader_buffer;
+    struct glsl_vs3_input_setup_shader *shader;
+    struct wine_rb_entry *entry;
     const char *semantic_name;
     UINT semantic_idx;
     char reg_mask[6];
     unsigned int i;
+    size_t size;
     GLuint ret;
 
     string_buffer_clear(buffer);
@@ -7234,10 +7251,38 @@ static GLuint shader_glsl_generate_vs3_rasterizer_input_setup(struct shader_glsl
 
     shader_addline(buffer, "}\n");
 
+    if ((entry = wine_rb_get(&priv->vs3_input_setup_shaders, buffer->buffer)))
+    {
+        shader = WINE_RB_ENTRY_VALUE(entry, struct glsl_vs3_input_setup_shader, entry);
+        TRACE("Reusing rasterizer input setup shader %u.\n", shader->id);
+        *cached = TRUE;
+        return shader->id;
+    }
+
     ret = GL_EXTCALL(glCreateShader(GL_VERTEX_SHADER));
     checkGLcall("glCreateShader(GL_VERTEX_SHADER)");
     shader_glsl_compile(gl_info, ret, buffer->buffer);
 
+    *cached = FALSE;
+    if (priv->vs3_input_setup_shader_count >= WINED3D_GLSL_MAX_VS3_INPUT_SETUP_SHADERS)
+        return ret;
+
+    size = strlen(buffer->buffer) + 1;
+    if (!(shader = heap_alloc(FIELD_OFFSET(struct glsl_vs3_input_setup_shader, source[size]))))
+        return ret;
+    shader->id = ret;
+    memcpy(shader->source, buffer->buffer, size);
+    if (wine_rb_put(&priv->vs3_input_setup_shaders, shader->source, &shader->entry) == -1)
+    {
+        ERR("Failed to insert rasterizer input setup shader.\n");
+        heap_free(shader);
+        return ret;
+    }
+    ++priv->vs3_input_setup_shader_count;
+    TRACE("Cached rasterizer input setup shader %u, %u shaders cached.\n",
+            ret, priv->vs3_input_setup_shader_count);
+    *cached = TRUE;
+
     return ret;
 }
 
@@ -10212,6 +10257,7 @@ static void set_glsl_shader_program(const struct wined3d_context_gl *context_gl,
     struct wined3d_shader *vshader = NULL;
     struct wined3d_shader *pshader = NULL;
     GLuint reorder_shader_id = 0;
+    BOOL reorder_shader_cached;
     struct glsl_program_key key;
     GLuint program_id;
     unsigned int i;
@@ -10373,13 +10419,16 @@ static void set_glsl_shader_program(const struct wined3d_context_gl *context_gl,
             reorder_shader_id = shader_glsl_generate_vs3_rasterizer_input_setup(priv, vshader, pshader,
                     state->primitive_type == WINED3D_PT_POINTLIST && vshader->reg_maps.point_size,
                     d3d_info->emulated_flatshading
-                    && state->render_states[WINED3D_RS_SHADEMODE] == WINED3D_SHADE_FLAT, gl_info);
+                    && state->render_states[WINED3D_RS_SHADEMODE] == WINED3D_SHADE_FLAT, gl_info,
+                    &reorder_shader_cached);
             TRACE("Attaching GLSL shader object %u to program %u.\n", reorder_shader_id, program_id);
             GL_EXTCALL(glAttachShader(program_id, reorder_shader_id));
             checkGLcall("glAttachShader");
             /* Flag the reorder function for deletion, it will be freed
-             * automatically when the program is destroyed. */
-            GL_EXTCALL(glDeleteShader(reorder_shader_id));
+             * automatically when the program is destroyed. Cached shaders
+             * are deleted in shader_glsl_free(). */
+            if (!reorder_shader_cached)
+                GL_EXTCALL(glDeleteShader(reorder_shader_id));
         }
     }
     else
@@ -10982,6 +11031,21 @@ static int glsl_program_key_compare(const void *key, const struct wine_rb_entry
     return 0;
 }
 
+static int glsl_vs3_input_setup_shader_compare(const void *key, const struct wine_rb_entry *entry)
+{
+    return strcmp(key, WINE_RB_ENTRY_VALUE(entry, const struct glsl_vs3_input_setup_shader, entry)->source);
+}
+
+static void shader_glsl_free_vs3_input_setup_shader(struct wine_rb_entry *entry, void *param)
+{
+    struct glsl_vs3_input_setup_shader *shader = WINE_RB_ENTRY_VALUE(entry,
+            struct glsl_vs3_input_setup_shader, entry);
+    const struct wined3d_gl_info *gl_info = param;
+
+    GL_EXTCALL(glDeleteShader(shader->id));
+    heap_free(shader);
+}
+
 static BOOL constant_heap_init(struct constant_heap *heap, unsigned int constant_count)
 {
     SIZE_T size = (constant_count + 1) * sizeof(*heap->entries)
@@ -11063,6 +11127,7 @@ static HRESULT shader_glsl_alloc(struct wined3d_device *device, const struct win
     }
 
     wine_rb_init(&priv->program_lookup, glsl_program_key_compare);
+    wine_rb_init(&priv->vs3_input_setup_shaders, glsl_vs3_input_setup_shader_compare);
 
     priv->next_constant_version = 1;
     priv->vertex_pipe = vertex_pipe;
@@ -11094,6 +11159,9 @@ static void shader_glsl_free(struct wined3d_device *device, struct wined3d_conte
     struct shader_glsl_priv *priv = device->shader_priv;
 
     wine_rb_destroy(&priv->program_lookup, NULL, NULL);
+    if (priv->vs3_input_setup_shader_count)
+        wine_rb_destroy(&priv->vs3_input_setup_shaders, shader_glsl_free_vs3_input_setup_shader,
+                (void *)wined3d_context_gl(context)->gl_info);
     constant_heap_free(&priv->pconst_heap);
     constant_heap_free(&priv->vconst_heap);
     heap_free(priv->stack);
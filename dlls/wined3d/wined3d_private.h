@@ -3983,6 +3983,7 @@ struct wined3d_device_vk
     VkQueue vk_queue;
     uint32_t vk_queue_family_index;
     uint32_t timestamp_bits;
+    VkPipelineCache vk_pipeline_cache;
 
     struct wined3d_vk_info vk_info;
 
@@ -1244,7 +1244,10 @@ typedef struct _UNWIND_HISTORY_TABLE_ENTRY
 typedef struct _UNWIND_HISTORY_TABLE
 {
     ULONG Count;
+    UCHAR LocalHint;
+    UCHAR GlobalHint;
     UCHAR Search;
+    UCHAR Once;
     ULONG64 LowAddress;
     ULONG64 HighAddress;
     UNWIND_HISTORY_TABLE_ENTRY Entry[UNWIND_HISTORY_TABLE_SIZE];
@@ -334,12 +334,30 @@ static void call_req_handler( struct thread *thread )
 /* read a request from a thread */
 void read_request( struct thread *thread )
 {
+    /* buffer for the variable sized data read along with the request header */
+    static char prefetch_data[4096];
     int ret;
 
     if (!thread->req_toread)  /* no pending request */
     {
-        if ((ret = read( get_unix_fd( thread->request_fd ), &thread->req,
-                         sizeof(thread->req) )) != sizeof(thread->req)) goto error;
+        struct iovec vec[2];
+
+        /* the client writes the whole request at once, so try to get the data in the same syscall */
+        vec[0].iov_base = &thread->req;
+        vec[0].iov_len  = sizeof(thread->req);
+        vec[1].iov_base = prefetch_data;
+        vec[1].iov_len  = sizeof(prefetch_data);
+
+        if ((ret = readv( get_unix_fd( thread->request_fd ), vec, 2 )) < (int)sizeof(thread->req))
+            goto error;
+        ret -= sizeof(thread->req);
+        if (ret > thread->req.request_header.request_size)
+        {
+            fatal_protocol_error( thread, "request %d has %d bytes of extra data\n",
+                                  thread->req.request_header.req,
+                                  ret - thread->req.request_header.request_size );
+            return;
+        }
         if (!(thread->req_toread = thread->req.request_header.request_size))
         {
             /* no data, handle request at once */
@@ -352,6 +370,15 @@ void read_request( struct thread *thread )
                                   thread->req_toread, thread->req.request_header.req );
             return;
         }
+        memcpy( thread->req_data, prefetch_data, ret );
+        if (!(thread->req_toread -= ret))
+        {
+            /* all the data was prefetched, no need to wait for more */
+            call_req_handler( thread );
+            free( thread->req_data );
+            thread->req_data = NULL;
+            return;
+        }
     }
 
     /* read the variable sized data */
@@ -74,6 +74,7 @@ struct thread_wait
     struct thread_wait     *next;       /* next wait structure for this thread */
     struct thread          *thread;     /* owner thread */
     int                     count;      /* count of objects */
+    int                     size;       /* number of allocated queue entries */
     int                     flags;
     int                     abandoned;
     enum select_op          select;
@@ -84,6 +85,9 @@ struct thread_wait
     struct wait_queue_entry queues[1];
 };
 
+/* max number of objects for a wait structure to be kept for reuse by the next wait */
+#define CACHED_WAIT_OBJECTS 4
+
 /* asynchronous procedure calls */
 
 struct thread_apc
@@ -238,6 +242,7 @@ static inline void init_thread_structure( struct thread *thread )
     thread->system_regs     = 0;
     thread->queue           = NULL;
     thread->wait            = NULL;
+    thread->wait_cache      = NULL;
     thread->error           = 0;
     thread->req_data        = NULL;
     thread->req_toread      = 0;
@@ -410,6 +415,7 @@ static void cleanup_thread( struct thread *thread )
     clear_apc_queue( &thread->user_apc );
     free( thread->req_data );
     free( thread->reply_data );
+    free( thread->wait_cache );
     if (thread->request_fd) release_object( thread->request_fd );
     if (thread->reply_fd) release_object( thread->reply_fd );
     if (thread->wait_fd) release_object( thread->wait_fd );
@@ -428,6 +434,7 @@ static void cleanup_thread( struct thread *thread )
     free( thread->desc );
     thread->req_data = NULL;
     thread->reply_data = NULL;
+    thread->wait_cache = NULL;
     thread->request_fd = NULL;
     thread->reply_fd = NULL;
     thread->wait_fd = NULL;
@@ -722,6 +729,30 @@ void make_wait_abandoned( struct wait_queue_entry *entry )
     entry->wait->abandoned = 1;
 }
 
+/* allocate a wait structure, reusing the cached one for small waits */
+static struct thread_wait *alloc_wait( struct thread *thread, unsigned int count )
+{
+    struct thread_wait *wait;
+    unsigned int size = max( count, CACHED_WAIT_OBJECTS );
+
+    if (size == CACHED_WAIT_OBJECTS && (wait = thread->wait_cache))
+    {
+        thread->wait_cache = NULL;
+        return wait;
+    }
+    if ((wait = mem_alloc( FIELD_OFFSET(struct thread_wait, queues[size]) ))) wait->size = size;
+    return wait;
+}
+
+/* free a wait structure, keeping it around for the next wait if possible */
+static void free_wait( struct thread *thread, struct thread_wait *wait )
+{
+    if (wait->size == CACHED_WAIT_OBJECTS && !thread->wait_cache && thread->state != TERMINATED)
+        thread->wait_cache = wait;
+    else
+        free( wait );
+}
+
 /* finish waiting */
 static unsigned int end_wait( struct thread *thread, unsigned int status )
 {
@@ -749,7 +780,7 @@ static unsigned int end_wait( struct thread *thread, unsigned int status )
     for (i = 0, entry = wait->queues; i < wait->count; i++, entry++)
         entry->obj->ops->remove_queue( entry->obj, entry );
     if (wait->user) remove_timeout_user( wait->user );
-    free( wait );
+    free_wait( thread, wait );
     return status;
 }
 
@@ -761,7 +792,7 @@ static int wait_on( const select_op_t *select_op, unsigned int count, struct obj
     struct wait_queue_entry *entry;
     unsigned int i;
 
-    if (!(wait = mem_alloc( FIELD_OFFSET(struct thread_wait, queues[count]) ))) return 0;
+    if (!(wait = alloc_wait( current, count ))) return 0;
     wait->next    = current->wait;
     wait->thread  = current;
     wait->count   = count;